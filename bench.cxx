@@ -10,13 +10,970 @@ using namespace kult;
 using name    = component<'name',std::string>;
 using counter = component<'cter',size_t>;
 
+struct vec2f {
+    float x, y;
+
+    template<typename T> friend T&operator<<( T &os, const vec2f &self ) {
+        return os << "(x:" << self.x << ",y:" << self.y << ")", os;
+    }
+};
+
 // our sample
 
 #include <chrono>
 #include <vector>
 #include <iomanip>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+// times a callable, in milliseconds
+template<typename FN>
+double ms( const FN &fn ) {
+    auto t_start = std::chrono::high_resolution_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t_start).count();
+}
+
+// compares kult stores against the former std::map backend, at N entities
+template<typename component>
+void bench_storage( size_t N ) {
+    std::vector<type> ids( N );
+    for( size_t i = 0; i < N; ++i ) ids[i] = type(i + 1);
+    std::vector<type> shuffled( ids );
+    std::shuffle( shuffled.begin(), shuffled.end(), std::mt19937(123) );
+
+    std::map<type, size_t> map;
+    size_t sum1 = 0, sum2 = 0;
+
+    double map_add = ms( [&]{ for( auto &id : ids ) map[id] = id; } );
+    double kult_add = ms( [&]{ for( auto &id : ids ) add<component>(id) = id; } );
+
+    double map_get = ms( [&]{ for( auto &id : shuffled ) sum1 += map[id]; } );
+    double kult_get = ms( [&]{ for( auto &id : shuffled ) sum2 += get<component>(id); } );
+
+    double map_it = ms( [&]{ for( auto &it : map ) sum1 += it.second; } );
+    double kult_it = ms( [&]{ for( auto &it : components<component>().values ) sum2 += it; } );
+
+    double map_del = ms( [&]{ for( auto &id : shuffled ) map.erase(id); } );
+    double kult_del = ms( [&]{ for( auto &id : shuffled ) del<component>(id); } );
+
+    std::cout << std::setw(8) << N << " entities (ms): "
+        << "add " << map_add << " -> " << kult_add << ", "
+        << "get " << map_get << " -> " << kult_get << ", "
+        << "iterate " << map_it << " -> " << kult_it << ", "
+        << "del " << map_del << " -> " << kult_del
+        << ( sum1 == sum2 ? "" : " (checksum mismatch!)" ) << std::endl;
+}
+
+// former per-entity layout: a whole component object (vptr included) inside a std::map node
+template<typename V>
+struct legacy {
+    virtual ~legacy() {}
+    V value_type;
+};
+
+// compares per-entity memory of kult stores against the former layout, at N entities
+template<typename component>
+void bench_footprint( const char *title, size_t N ) {
+    using V = value_of<component>;
+    for( size_t i = 0; i < N; ++i ) add<component>( type(i + 1) );
+
+    auto &st = components<component>();
+    size_t pages = 0;
+    for( auto &page : st.pages ) pages += !!page;
+    size_t now = st.values.capacity() * sizeof(V) + st.dense.capacity() * sizeof(type)
+        + st.pages.capacity() * sizeof(st.pages[0]) + pages * sparse::PAGE_SIZE * sizeof(type);
+    size_t before = N * ( 4 * sizeof(void*) + sizeof(std::pair<const type, legacy<V>>) ); // rb-tree node header + pair
+
+    std::cout << std::setw(12) << title << ": " << double(before) / N << " -> " << double(now) / N << " bytes per entity" << std::endl;
+    for( size_t i = 0; i < N; ++i ) del<component>( type(i + 1) );
+}
+
+// compares materialized set joins (former path) against lazy join views, at N entities
+template<typename A, typename B, typename C, typename D>
+void bench_join( size_t N, int frames ) {
+    for( size_t i = 0; i < N; ++i ) {
+        type id = type(i + 1);
+        add<A>(id) = 1;
+        if( i % 2 == 0 ) add<B>(id) = 1;
+        if( i % 3 == 0 ) add<C>(id) = 1;
+        if( i % 4 == 0 ) add<D>(id) = 1;
+    }
+
+    size_t sum1 = 0, sum2 = 0;
+    double set2 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : group_by<JOIN>( any<A>(), any<B>() ) ) sum1 += get<A>(id); } );
+    double view2 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : join<A,B>() ) sum2 += get<A>(id); } );
+    double set3 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : group_by<JOIN>( any<A>(), group_by<JOIN>( any<B>(), any<C>() ) ) ) sum1 += get<A>(id); } );
+    double view3 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : join<A,B,C>() ) sum2 += get<A>(id); } );
+    double set4 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : group_by<JOIN>( any<A>(), group_by<JOIN>( any<B>(), group_by<JOIN>( any<C>(), any<D>() ) ) ) ) sum1 += get<A>(id); } );
+    double view4 = ms( [&]{ for( int f = 0; f < frames; ++f ) for( auto &id : join<A,B,C,D>() ) sum2 += get<A>(id); } );
+
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): "
+        << "2-way " << set2 << " -> " << view2 << ", "
+        << "3-way " << set3 << " -> " << view3 << ", "
+        << "4-way " << set4 << " -> " << view4
+        << ( sum1 == sum2 ? "" : " (checksum mismatch!)" ) << std::endl;
+
+    for( size_t i = 0; i < N; ++i ) {
+        type id = type(i + 1);
+        del<A>(id), del<B>(id), del<C>(id), del<D>(id);
+    }
+}
+
+// per-join cost of materializing results as kult::entity (former any<T>/group_by element) vs plain ids
+template<typename A, typename B>
+void bench_entity_sets( size_t N, int frames ) {
+    for( size_t i = 0; i < N; ++i ) {
+        type id = type(i + 1);
+        add<A>(id) = 1;
+        if( i % 2 == 0 ) add<B>(id) = 1;
+    }
+    size_t sum1 = 0, sum2 = 0;
+    double entities = ms( [&]{
+        for( int f = 0; f < frames; ++f ) {
+            kult::set<entity> result;
+            for( auto &id : join<A,B>() ) result.insert( id.id );
+            sum1 += result.size();
+        }
+    } );
+    double plain = ms( [&]{
+        for( int f = 0; f < frames; ++f ) {
+            kult::set<type> result = join<A,B>();
+            sum2 += result.size();
+        }
+    } );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): set<entity> " << entities << " -> set<type> " << plain
+        << ( sum1 == sum2 ? "" : " (checksum mismatch!)" ) << std::endl;
+    for( size_t i = 0; i < N; ++i ) {
+        type id = type(i + 1);
+        del<A>(id), del<B>(id);
+    }
+}
+
+// movement system over sparse stores (join view + lookups) against archetype chunks, at N entities
+using spos = component<'spos', vec2f>;
+using svel = component<'svel', vec2f>;
+using apos = component<'apos', vec2f>;
+using avel = component<'avel', vec2f>;
+namespace kult {
+    template<> struct archetyped<apos> : std::true_type {};
+    template<> struct archetyped<avel> : std::true_type {};
+}
+
+void bench_archetypes( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<spos>(e) = { 0, 0 }, add<svel>(e) = { 1, 2 };
+        add<apos>(e) = { 0, 0 }, add<avel>(e) = { 1, 2 };
+    }
+    const float dt = 1/60.f;
+    double sparse = ms( [&]{
+        for( int f = 0; f < frames; ++f ) for( auto &e : join<spos, svel>() ) {
+            vec2f &p = get<spos>(e); const vec2f &v = get<svel>(e);
+            p.x += v.x * dt, p.y += v.y * dt;
+        }
+    } );
+    double chunked = ms( [&]{
+        for( int f = 0; f < frames; ++f ) chunks<apos, avel>( [&]( size_t n, const type *, vec2f *p, vec2f *v ) {
+            for( size_t i = 0; i < n; ++i ) p[i].x += v[i].x * dt, p[i].y += v[i].y * dt;
+        } );
+    } );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): join " << sparse << " -> chunks " << chunked << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// movement system over join views plus get<>() against each<>(), which resolves every component once
+using epos = component<'epos', vec2f>;
+using evel = component<'evel', vec2f>;
+
+void bench_each( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( size_t i = 0; i < N; ++i ) {
+        list[i] = id();
+        add<epos>(list[i]) = { 0, 0 };
+        if( i % 2 ) add<evel>(list[i]) = { 1, 2 };
+    }
+    const float dt = 1/60.f;
+    double joined = ms( [&]{
+        for( int f = 0; f < frames; ++f ) for( auto &e : join<epos, evel>() ) {
+            get<epos>(e).x += get<evel>(e).x * dt;
+            get<epos>(e).y += get<evel>(e).y * dt;
+        }
+    } );
+    double each_ = ms( [&]{
+        for( int f = 0; f < frames; ++f ) each<epos, evel>( [&]( type, vec2f &p, vec2f &v ) {
+            p.x += v.x * dt, p.y += v.y * dt;
+        } );
+    } );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): join+get " << joined << " -> each " << each_ << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// movement system over join views against a persistent group, at N entities where half of them move
+using gpos = component<'gpos', vec2f>;
+using gvel = component<'gvel', vec2f>;
+
+void bench_groups( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( size_t i = 0; i < N; ++i ) {
+        list[i] = id();
+        add<gpos>(list[i]) = { 0, 0 };
+        if( i % 2 ) add<gvel>(list[i]) = { 1, 2 };
+    }
+    auto &moving = groups<gpos, gvel>();
+    const float dt = 1/60.f;
+    double joined = ms( [&]{
+        for( int f = 0; f < frames; ++f ) for( auto &e : join<gpos, gvel>() ) {
+            vec2f &p = get<gpos>(e); const vec2f &v = get<gvel>(e);
+            p.x += v.x * dt, p.y += v.y * dt;
+        }
+    } );
+    double grouped = ms( [&]{
+        for( int f = 0; f < frames; ++f ) moving.each( [&]( type, vec2f &p, vec2f &v ) {
+            p.x += v.x * dt, p.y += v.y * dt;
+        } );
+    } );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): join " << joined << " -> group " << grouped << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// movement system through parallel_each, at N entities on 1..cores threads
+using ppos = component<'ppos', vec2f>;
+using pvel = component<'pvel', vec2f>;
+
+void bench_parallel( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<ppos>(e) = { 0, 0 }, add<pvel>(e) = { 1, 2 };
+    }
+    const float dt = 1/60.f;
+    const size_t cores = std::max<size_t>( 4, std::thread::hardware_concurrency() );
+    for( size_t count = 1; count <= cores; count *= 2 ) {
+        threads( count );
+        double t = ms( [&]{
+            for( int f = 0; f < frames; ++f ) parallel_each( join<ppos, pvel>(), [&]( type e ) {
+                vec2f &p = get<ppos>(e); const vec2f &v = get<pvel>(e);
+                p.x += v.x * dt, p.y += v.y * dt;
+            } );
+        } );
+        std::cout << std::setw(8) << N << " entities x " << frames << " frames, " << count << " threads (ms): " << t << std::endl;
+    }
+    threads( std::thread::hardware_concurrency() );
+    for( auto &e : list ) purge(e);
+}
+
+// structural changes: immediate add/del vs a command buffer recorded from parallel workers, flushed once
+using cpos = component<'cpos', vec2f>;
+using ctag = component<'ctag', bool>;
+
+void bench_commands( size_t N ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<cpos>(e) = { float(e % 100), 0 };
+    }
+    double immediate = ms( [&]{
+        for( auto &e : list ) if( get<cpos>(e).x < 50 ) add<ctag>(e) = true;
+        for( auto &e : list ) del<ctag>(e);
+    } );
+    double deferred = ms( [&]{
+        parallel_each( join<cpos>(), [&]( type e ) {
+            if( get<cpos>(e).x < 50 ) kult::deferred().add<ctag>( e, true );
+        } );
+        flush();
+        parallel_each( join<cpos>(), [&]( type e ) {
+            kult::deferred().del<ctag>( e );
+        } );
+        flush();
+    } );
+    std::cout << std::setw(8) << N << " entities (ms): immediate " << immediate << " -> deferred " << deferred << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// checkpointing: text dump() of every entity vs binary snapshot save/load (memory and mmap'd file)
+using snpos = component<'snps', vec2f>;
+using snhp  = component<'snhp', int>;
+using sntag = component<'sntg', std::string>;
+
+void bench_snapshot( size_t N ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<snpos>(e) = { float(e), 0 }, add<snhp>(e) = 100;
+        if( e % 10 == 0 ) add<sntag>(e) = "tagged";
+    }
+    size_t text = 0;
+    double dumped = ms( [&]{
+        for( auto &e : list ) text += dump(e).size();
+    } );
+    std::string blob;
+    double saved = ms( [&]{ blob = save(); } );
+    double loaded = ms( [&]{ load( blob.data(), blob.size() ); } );
+    double written = ms( [&]{ save( "bench.snapshot.bin" ); } );
+    double mapped = ms( [&]{ load( "bench.snapshot.bin" ); } );
+    std::remove( "bench.snapshot.bin" );
+    std::cout << std::setw(8) << N << " entities (ms): dump " << dumped << " (" << text / 1024 << " KiB) -> save " << saved
+              << ", load " << loaded << " (" << blob.size() / 1024 << " KiB); file save " << written << ", mmap load " << mapped << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// debug endpoint: dump() strings of every entity vs streaming into one reused buffer vs exporting the world
+void bench_dumps( size_t N ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<snpos>(e) = { float(e), 0 }, add<snhp>(e) = 100;
+        if( e % 10 == 0 ) add<sntag>(e) = "tagged";
+    }
+    size_t text = 0;
+    double strings = ms( [&]{ // former dump(id): a stringstream per entity
+        for( auto &e : list ) {
+            std::stringstream ss; ss << '{';
+            size_t items = 0;
+            visit( e, e, [&]( const interface *it ) { it->dump( ss, e, TEXT, items ); } );
+            ss << '}';
+            text += ss.str().size();
+        }
+    } );
+    std::string out;
+    double streamed = ms( [&]{
+        for( auto &e : list ) dump( out, e );
+    } );
+    std::string all, json;
+    double exported = ms( [&]{ dump( all ); } );
+    double jsoned = ms( [&]{ dump( json, JSON ); } );
+    std::cout << std::setw(8) << N << " entities (ms): dump strings " << strings << " (" << text / 1024 << " KiB) -> one buffer " << streamed
+              << " (" << out.size() / 1024 << " KiB) -> world export " << exported << " (" << all.size() / 1024 << " KiB), json " << jsoned
+              << " (" << json.size() / 1024 << " KiB)" << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// replication: per-frame save + diff against the previous frame, then patch on a rollback copy
+void bench_delta( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<snpos>(e) = { 0, 0 }, add<snhp>(e) = 100;
+    }
+    std::string previous = save(), current;
+    size_t bytes = 0, moved = N / 100;
+    double diffing = 0, patching = 0;
+    for( int f = 0; f < frames; ++f ) {
+        for( size_t i = 0; i < moved; ++i ) get<snpos>( list[ ( i * 97 + f ) % N ] ).x += 1;
+        std::string delta;
+        diffing += ms( [&]{ current = save(); delta = diff( previous, current ); } );
+        bytes += delta.size();
+        load( previous.data(), previous.size() );
+        patching += ms( [&]{ patch( delta ); } );
+        previous.swap( current );
+    }
+    std::cout << std::setw(8) << N << " entities, " << moved << " changed x " << frames << " frames (ms/frame): save+diff " << diffing / frames
+              << ", patch " << patching / frames << "; delta " << bytes / frames << " bytes vs snapshot " << previous.size() << " bytes" << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// same frames on versioned<> components: tracker::next() reads the stamps instead of snapshotting twice
+using trpos = component<'trps', vec2f>;
+using trhp  = component<'trhp', int>;
+namespace kult {
+    template<> struct versioned<trpos> : std::true_type {};
+    template<> struct versioned<trhp>  : std::true_type {};
+}
+
+void bench_tracker( size_t N, int frames ) {
+    std::vector<type> list = create( N );
+    add<trpos>( list.begin(), list.end(), vec2f { 0, 0 } ), add<trhp>( list.begin(), list.end(), 100 );
+    std::string previous = save(), current;
+    size_t diffed = 0, tracked = 0, moved = N / 100;
+    double diffing = 0, tracking = 0;
+    tracker replica;
+    for( int f = 0; f < frames; ++f ) {
+        for( size_t i = 0; i < moved; ++i ) get<trpos>( list[ ( i * 97 + f ) % N ] ).x += 1;
+        std::string delta, step;
+        diffing += ms( [&]{ current = save(); delta = diff( previous, current ); } );
+        tracking += ms( [&]{ step = replica.next(); } );
+        diffed += delta.size(), tracked += step.size();
+        previous.swap( current );
+    }
+    std::cout << std::setw(8) << N << " versioned entities, " << moved << " changed x " << frames << " frames (ms/frame): save+diff " << diffing / frames
+              << " (" << diffed / frames << " bytes) -> tracker " << tracking / frames << " (" << tracked / frames << " bytes)" << std::endl;
+    purge( list.begin(), list.end() );
+}
+
+// editor undo: dump() of the touched entity before every edit vs the journal
+using jpos = component<'jpos', vec2f>;
+using jtag = component<'jtag', std::string>;
+
+void bench_journal( size_t N, size_t edits ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<jpos>(e) = { 0, 0 }, add<jtag>(e) = "item";
+    }
+    std::vector<std::string> dumps;
+    double dumped = ms( [&]{
+        for( size_t i = 0; i < edits; ++i ) {
+            type e = list[ ( i * 7919 ) % N ];
+            dumps.push_back( dump(e) );
+            get<jpos>(e).x += 1;
+        }
+    } );
+    journaling().enable();
+    double journaled = ms( [&]{
+        for( size_t i = 0; i < edits; ++i ) {
+            type e = list[ ( i * 7919 ) % N ];
+            touch<jpos>(e).x += 1;
+        }
+    } );
+    const size_t bytes = journaling().bytes;
+    double undone = ms( [&]{ undo( edits ); } );
+    journaling().disable();
+    std::cout << std::setw(8) << edits << " edits (ms): dump " << dumped << " -> journal " << journaled << " (" << bytes / 1024 << " KiB), undo all " << undone << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// waves of units: per-id id()/add/spawn/purge vs the batched forms
+using bpos = component<'bpos', vec2f>;
+using bhp  = component<'bhp_', int>;
+
+void bench_batches( size_t N ) {
+    type proto = id();
+    add<bpos>(proto) = { 1, 2 }, add<bhp>(proto) = 100;
+
+    double single = 1e9, single_spawn = 1e9, single_purge = 1e9, batched = 1e9, batched_spawn = 1e9, batched_purge = 1e9;
+    for( int pass = 0; pass < 3; ++pass ) { // alternating, best of 3: both sides run on warm pools and pages
+        std::vector<type> list;
+        single = std::min( single, ms( [&]{
+            for( size_t i = 0; i < N; ++i ) {
+                list.push_back( id() );
+                add<bpos>( list.back() ) = { 0, 0 }, add<bhp>( list.back() ) = 100;
+            }
+        } ) );
+        single_spawn = std::min( single_spawn, ms( [&]{ for( size_t i = 0; i < N; ++i ) list.push_back( spawn( proto ) ); } ) );
+        single_purge = std::min( single_purge, ms( [&]{ for( auto &e : list ) purge(e); } ) );
+
+        list.clear();
+        batched = std::min( batched, ms( [&]{
+            list = create( N );
+            add<bpos>( list.begin(), list.end(), vec2f { 0, 0 } ), add<bhp>( list.begin(), list.end(), 100 );
+        } ) );
+        batched_spawn = std::min( batched_spawn, ms( [&]{ auto copies = spawn( proto, N ); list.insert( list.end(), copies.begin(), copies.end() ); } ) );
+        batched_purge = std::min( batched_purge, ms( [&]{ purge( list.begin(), list.end() ); } ) );
+    }
+
+    std::cout << std::setw(8) << N << " units (ms): create+add " << single << " -> " << batched << ", spawn " << single_spawn << " -> " << batched_spawn
+              << ", purge " << single_purge << " -> " << batched_purge << std::endl;
+    purge(proto);
+}
+
+// whole-entity operations: walking every registered component (former path) vs signature bits
+using sga = component<'sg_a', int>;
+using sgb = component<'sg_b', vec2f>;
+
+void bench_signatures( size_t N ) {
+    type proto = id();
+    add<sga>(proto) = 1, add<sgb>(proto) = { 1, 2 };
+    auto &registered = interface::registered();
+
+    std::vector<type> list;
+    double walked = ms( [&]{
+        for( size_t i = 0; i < N; ++i ) {
+            list.push_back( id() );
+            for( auto &it : registered ) it->copy( list.back(), proto );
+        }
+        for( auto &e : list ) {
+            for( auto &it : registered ) it->purge( e );
+            ids().erase( e );
+        }
+    } );
+    list.clear();
+    double signed_ = ms( [&]{
+        for( size_t i = 0; i < N; ++i ) list.push_back( spawn( proto ) );
+        for( auto &e : list ) purge( e );
+    } );
+    std::cout << std::setw(8) << N << " entities, " << registered.size() << " registered components (ms): spawn+purge " << walked << " -> " << signed_ << std::endl;
+    purge(proto);
+}
+
+// movement system over an owning group, array-of-structs payloads against split (structure-of-arrays) ones
+struct svec2f {
+    float x, y;
+
+    template<typename T> friend T&operator<<( T &os, const svec2f &self ) {
+        return os << "(x:" << self.x << ",y:" << self.y << ")", os;
+    }
+};
+namespace kult {
+    template<> struct fields<svec2f> : fields_of<float, 2> {};
+}
+using xpos = component<'xpos', vec2f>;
+using xvel = component<'xvel', vec2f>;
+using zpos = component<'zpos', svec2f>;
+using zvel = component<'zvel', svec2f>;
+
+void bench_split( size_t N, int frames ) {
+    std::vector<type> list( N );
+    for( auto &e : list ) {
+        e = id();
+        add<xpos>(e) = { 0, 0 }, add<xvel>(e) = { 1, 2 };
+        add<zpos>(e) = svec2f{ 0, 0 }, add<zvel>(e) = svec2f{ 1, 2 };
+    }
+    const float dt = 1/60.f;
+    double aos = ms( [&]{
+        for( int f = 0; f < frames; ++f ) groups<xpos, xvel>().columns( [&]( size_t n, const type *, vec2f *p, vec2f *v ) {
+            for( size_t i = 0; i < n; ++i ) p[i].x += v[i].x * dt, p[i].y += v[i].y * dt;
+        } );
+    } );
+    double soa = ms( [&]{
+        for( int f = 0; f < frames; ++f ) groups<zpos, zvel>().columns( [&]( size_t n, const type *, columnar<svec2f>::pointer p, columnar<svec2f>::pointer v ) {
+            axpy( p.column[0], v.column[0], dt, n );
+            axpy( p.column[1], v.column[1], dt, n );
+        } );
+    } );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): aos " << aos << " -> soa " << soa << std::endl;
+    for( auto &e : list ) purge(e);
+}
+
+// copying a world, and stepping several worlds one after another against all at once
+using wpos = component<'wpos', vec2f>;
+using wvel = component<'wvel', vec2f>;
+
+void bench_worlds( size_t N, size_t count, int frames ) {
+    world proto;
+    {
+        world::scope use( proto );
+        std::vector<type> list = create( N );
+        add<wpos>( list.begin(), list.end(), vec2f { 0, 0 } );
+        add<wvel>( list.begin(), list.end(), vec2f { 1, 2 } );
+    }
+    std::vector< std::unique_ptr<world> > sims;
+    double copied = ms( [&]{
+        for( size_t i = 0; i < count; ++i ) sims.emplace_back( new world( proto ) );
+    } );
+    const float dt = 1/60.f;
+    auto step = [&]( world &w ) {
+        world::scope use( w );
+        for( int f = 0; f < frames; ++f ) each<wpos, wvel>( [&]( type, vec2f &p, vec2f &v ) {
+            p.x += v.x * dt, p.y += v.y * dt;
+        } );
+    };
+    double serial = ms( [&]{
+        for( auto &w : sims ) step( *w );
+    } );
+    double concurrent = ms( [&]{
+        std::vector<std::thread> steps;
+        for( auto &w : sims ) steps.emplace_back( [&] { step( *w ); } );
+        for( auto &th : steps ) th.join();
+    } );
+    std::cout << std::setw(8) << N << " entities x " << count << " worlds (ms): copy " << copied << ", " << frames << " frames one by one " << serial << " -> at once " << concurrent << std::endl;
+}
+
+// 2- and 3-way joins after heavy churn, as is against sorted and aligned stores
+using opos = component<'opos', vec2f>;
+using ovel = component<'ovel', vec2f>;
+using oacc = component<'oacc', vec2f>;
+
+void bench_sort( size_t N, int frames ) {
+    std::vector<type> list = create( N );
+    std::mt19937 rng( 42 );
+    for( int pass = 0; pass < 3; ++pass ) { // components added in a different random order each
+        std::shuffle( list.begin(), list.end(), rng );
+        for( auto &e : list ) {
+            if( !has<opos>(e) ) add<opos>(e) = { 0, 0 };
+            else if( !has<ovel>(e) ) add<ovel>(e) = { 1, 2 };
+            else add<oacc>(e) = { 0, -1 };
+        }
+    }
+    for( int round = 0; round < 4; ++round ) { // churn: drop and re-add a third of every store, in random order
+        std::shuffle( list.begin(), list.end(), rng );
+        for( size_t i = 0; i < N / 3; ++i ) del<opos>( list[i] ), del<ovel>( list[i] ), del<oacc>( list[i] );
+        std::shuffle( list.begin(), list.begin() + N / 3, rng );
+        for( size_t i = 0; i < N / 3; ++i ) add<ovel>( list[i] ) = { 1, 2 }, add<oacc>( list[i] ) = { 0, -1 }, add<opos>( list[i] ) = { 0, 0 };
+    }
+    const float dt = 1/60.f;
+    auto step2 = [&]{
+        for( int f = 0; f < frames; ++f ) for( auto &e : join<opos, ovel>() ) {
+            vec2f &p = get<opos>(e); const vec2f &v = get<ovel>(e);
+            p.x += v.x * dt, p.y += v.y * dt;
+        }
+    };
+    auto step3 = [&]{
+        for( int f = 0; f < frames; ++f ) for( auto &e : join<opos, ovel, oacc>() ) {
+            vec2f &v = get<ovel>(e); const vec2f &a = get<oacc>(e);
+            v.x += a.x * dt, v.y += a.y * dt;
+            vec2f &p = get<opos>(e);
+            p.x += v.x * dt, p.y += v.y * dt;
+        }
+    };
+    double churned2 = ms( step2 ), churned3 = ms( step3 );
+    double sorting = ms( [&]{ sort<opos>(), align<ovel, opos>(), align<oacc, opos>(); } );
+    double sorted2 = ms( step2 ), sorted3 = ms( step3 );
+    std::cout << std::setw(8) << N << " entities x " << frames << " frames (ms): 2-way " << churned2 << " -> " << sorted2
+        << ", 3-way " << churned3 << " -> " << sorted3 << " (sort + align once: " << sorting << ")" << std::endl;
+    purge( list.begin(), list.end() );
+}
+
+// a reactive system picking up the few values written since its last run: full scan against changed<>()
+using rpos = component<'rpos', vec2f>;
+namespace kult {
+    template<> struct versioned<rpos> : std::true_type {};
+}
+
+void bench_versions( size_t N, size_t writes, int frames ) {
+    std::vector<type> list = create( N );
+    add<rpos>( list.begin(), list.end(), vec2f { 0, 0 } );
+    std::vector<vec2f> last( N, vec2f { 0, 0 } ); // what the full scan compares against
+    std::mt19937 rng( 7 );
+    size_t seen1 = 0, seen2 = 0;
+    double scan = 0, query = 0;
+    uint32_t since = advance();
+    for( int f = 0; f < frames; ++f ) {
+        for( size_t i = 0; i < writes; ++i ) get<rpos>( list[ rng() % N ] ).x += 1;
+        scan += ms( [&]{
+            for( size_t i = 0; i < N; ++i ) {
+                const vec2f &p = *components<rpos>().find( list[i] ); // reading through get<>() would count as a write
+                if( p.x != last[i].x || p.y != last[i].y ) last[i] = p, ++seen1;
+            }
+        } );
+        query += ms( [&]{
+            changed<rpos>( since, [&]( type ) { ++seen2; } );
+            since = advance();
+        } );
+    }
+    std::cout << std::setw(8) << N << " entities, " << writes << " writes x " << frames << " frames (ms): scan " << scan << " -> changed<> " << query
+        << ( seen1 <= seen2 ? "" : " (missed changes!)" ) << std::endl;
+    purge( list.begin(), list.end() );
+}
+
+// keeping a render list in sync with a component under light churn: diffing join() every frame against
+// batched observers
+using vis = component<'vis_', bool>;
+
+void bench_observers( size_t N, size_t churn, int frames ) {
+    std::vector<type> list = create( N );
+    add<vis>( list.begin(), list.begin() + N / 2, true );
+    std::mt19937 rng( 3 );
+    auto step = [&]{
+        for( size_t i = 0; i < churn; ++i ) {
+            const type e = list[ rng() % N ];
+            if( has<vis>( e ) ) del<vis>( e ); else add<vis>( e ) = true;
+        }
+    };
+    std::vector<type> shown1( components<vis>().begin(), components<vis>().end() );
+    std::sort( shown1.begin(), shown1.end() );
+    double diffing = ms( [&]{
+        for( int f = 0; f < frames; ++f ) {
+            step();
+            std::vector<type> now( components<vis>().begin(), components<vis>().end() ), in, out;
+            std::sort( now.begin(), now.end() );
+            std::set_difference( now.begin(), now.end(), shown1.begin(), shown1.end(), std::back_inserter( in ) );
+            std::set_difference( shown1.begin(), shown1.end(), now.begin(), now.end(), std::back_inserter( out ) );
+            shown1.swap( now );
+        }
+    } );
+    std::unordered_set<type> shown2( components<vis>().begin(), components<vis>().end() );
+    batched<vis>( ON_ADD, [&]( size_t n, const type *ids ) { shown2.insert( ids, ids + n ); } );
+    batched<vis>( ON_REMOVE, [&]( size_t n, const type *ids ) { for( size_t i = 0; i < n; ++i ) shown2.erase( ids[i] ); } );
+    double observing = ms( [&]{
+        for( int f = 0; f < frames; ++f ) step(), deliver();
+    } );
+    std::cout << std::setw(8) << N << " entities, " << churn << " changes x " << frames << " frames (ms): diff join " << diffing << " -> batched observers " << observing
+        << ( shown2.size() == components<vis>().size() ? "" : " (out of sync!)" ) << std::endl;
+    unobserve<vis>();
+    purge( list.begin(), list.end() );
+}
+
+// whole-entity copy and purge through the runtime registry against a compile-time registry<T...>
+using kpos = component<'kpos', vec2f>;
+using kvel = component<'kvel', vec2f>;
+using khp  = component<'khp_', int>;
+
+void bench_registry( size_t N ) {
+    using known = registry<kpos, kvel, khp>;
+    type src = id();
+    add<kpos>( src ) = { 1, 2 }, add<kvel>( src ) = { 3, 4 }, add<khp>( src ) = 100;
+    std::vector<type> list = create( N );
+    double copy1 = 1e9, copy2 = 1e9, purge1 = 1e9, purge2 = 1e9;
+    for( int run = 0; run < 3; ++run ) { // alternate, so both see the same warmed up stores and recycled ids
+        copy1 = std::min( copy1, ms( [&]{ for( auto &e : list ) copy( e, src ); } ) );
+        purge1 = std::min( purge1, ms( [&]{ for( auto &e : list ) purge( e ); } ) );
+        list = create( N );
+        copy2 = std::min( copy2, ms( [&]{ for( auto &e : list ) known::copy( e, src ); } ) );
+        purge2 = std::min( purge2, ms( [&]{ for( auto &e : list ) known::purge( e ); } ) );
+        list = create( N );
+    }
+    std::cout << std::setw(8) << N << " entities, " << interface::registered().size() << " registered components (ms): "
+        << "copy " << copy1 << " -> " << copy2 << ", purge " << purge1 << " -> " << purge2 << std::endl;
+    purge( src );
+}
+
+// spawning and purging waves of entities, heap against an arena. prints the budget of the last wave.
+void bench_arena( size_t N, int waves ) {
+    auto churn = [&]( world &w ) {
+        world::scope use( w );
+        return ms( [&]{
+            for( int i = 0; i < waves; ++i ) {
+                std::vector<type> list = create( N );
+                add<wpos>( list.begin(), list.end(), vec2f { 0, 0 } );
+                add<wvel>( list.begin(), list.end(), vec2f { 1, 2 } );
+                if( i + 1 < waves ) purge( list.begin(), list.end() );
+            }
+        } );
+    };
+    world heap;
+    arena pool;
+    world pooled( pool );
+    double a = churn( heap ), b = churn( pooled );
+    std::cout << std::setw(8) << N << " entities x " << waves << " waves (ms): heap " << a << " -> arena " << b << std::endl;
+    world::scope use( pooled );
+    for( auto &it : budgets() ) if( it.count ) {
+        std::cout << "    " << it.name << ": " << it.count << " live, " << it.used << " used, " << it.reserved << " reserved, " << it.allocations << " allocations" << std::endl;
+    }
+}
+
+// kult::scenarios
+//
+// bench [--max N] [--only name] [--json | --csv] [--out file] [--baseline file] [--tolerance pct]
+// bench compare
+//
+// scenarios time the common workloads at 1k..10M entities (up to --max, 1M by default), each one in a
+// fresh world, taking the best of a few runs. results are printed as a table, or as json/csv for tools;
+// both formats can be fed back as --baseline, in which case slower results are flagged and the exit
+// code is non-zero. `bench compare` runs the side-by-side comparisons of former implementations instead.
+
+using sca = component<'sc_a', vec2f>;
+using scb = component<'sc_b', int>;
+using scc = component<'sc_c', int>;
+using scd = component<'sc_d', int>;
+using scs = component<'sc_s', std::string>;
+
+struct result {
+    std::string scenario;
+    size_t entities, ops;
+    double ms;
+    double ns() const {
+        return ops ? ms * 1e6 / ops : 0;
+    }
+};
+
+// a scenario prepares a world with setup( N ), then runs( N ) under the clock. runs() returns its ops.
+struct scenario {
+    std::string name;
+    std::function< void( size_t ) > setup;
+    std::function< size_t( size_t ) > run;
+};
+
+// N ids; every entity has A, and one in `every` has B (C, D at half and a quarter of that density)
+inline std::vector<type> populate( size_t N, size_t every = 1, bool more = false ) {
+    std::vector<type> list = create( N );
+    add<sca>( list.begin(), list.end(), vec2f { 1, 1 } );
+    std::vector<type> b, c, d;
+    for( size_t i = 0; i < N; ++i ) {
+        if( i % every == 0 ) b.push_back( list[i] );
+        if( more && i % ( every * 2 ) == 0 ) c.push_back( list[i] );
+        if( more && i % ( every * 4 ) == 0 ) d.push_back( list[i] );
+    }
+    add<scb>( b.begin(), b.end(), 1 );
+    add<scc>( c.begin(), c.end(), 1 );
+    add<scd>( d.begin(), d.end(), 1 );
+    return list;
+}
+
+volatile double sink; // keeps results of timed loops alive
+
+template<typename VIEW>
+inline size_t visit_all( const VIEW &view ) {
+    size_t visited = 0;
+    float sum = 0;
+    for( auto &id : view ) sum += get<sca>( id ).x, ++visited;
+    return sink = sum, visited;
+}
+
+std::vector<scenario> scenarios() {
+    static std::vector<type> list;
+    std::vector<scenario> all;
+    auto none = []( size_t ) { list.clear(); };
+    auto ids_only = []( size_t N ) { list = create( N ); };
+    auto full = []( size_t N ) { list = populate( N, 2, true ); };
+
+    all.push_back( { "create", none, []( size_t N ) { list = create( N ); return N; } } );
+    all.push_back( { "purge", full, []( size_t N ) { purge( list.begin(), list.end() ); return N; } } );
+    all.push_back( { "churn", full, []( size_t N ) {
+        for( int round = 0; round < 4; ++round ) {
+            purge( list.begin(), list.begin() + N / 2 );
+            std::vector<type> fresh = create( N / 2 );
+            add<sca>( fresh.begin(), fresh.end(), vec2f { 0, 0 } );
+            std::copy( fresh.begin(), fresh.end(), list.begin() );
+            std::rotate( list.begin(), list.begin() + N / 2, list.end() );
+        }
+        return 4 * ( N / 2 );
+    } } );
+    all.push_back( { "add", ids_only, []( size_t N ) { for( auto &id : list ) add<scb>( id ) = 1; return N; } } );
+    all.push_back( { "del", full, []( size_t N ) { for( auto &id : list ) del<scb>( id ); return N; } } );
+    all.push_back( { "get", full, []( size_t N ) {
+        std::shuffle( list.begin(), list.end(), std::mt19937( 123 ) );
+        float sum = 0;
+        for( auto &id : list ) sum += get<sca>( id ).x;
+        return sink = sum, N;
+    } } );
+    all.push_back( { "iterate", full, []( size_t N ) {
+        size_t n = 0;
+        each<sca>( [&]( type, vec2f &p ) { p.x += 1, ++n; } );
+        return n;
+    } } );
+    all.push_back( { "join1", full, []( size_t N ) { return visit_all( join<sca>() ); } } );
+    all.push_back( { "join2", full, []( size_t N ) { return visit_all( join<sca, scb>() ); } } );
+    all.push_back( { "join3", full, []( size_t N ) { return visit_all( join<sca, scb, scc>() ); } } );
+    all.push_back( { "join4", full, []( size_t N ) { return visit_all( join<sca, scb, scc, scd>() ); } } );
+    all.push_back( { "join2@10%", []( size_t N ) { list = populate( N, 10 ); }, []( size_t N ) { return visit_all( join<sca, scb>() ); } } );
+    all.push_back( { "join2@1%", []( size_t N ) { list = populate( N, 100 ); }, []( size_t N ) { return visit_all( join<sca, scb>() ); } } );
+    all.push_back( { "exclude", full, []( size_t N ) { return visit_all( exclude<scb>( join<sca>() ) ); } } );
+    all.push_back( { "copy", full, []( size_t N ) {
+        std::vector<type> fresh = create( N );
+        for( size_t i = 0; i < N; ++i ) copy( fresh[i], list[i] );
+        return N;
+    } } );
+    all.push_back( { "spawn", full, []( size_t N ) { spawn( list[0], N ); return N; } } );
+    all.push_back( { "dump", []( size_t N ) {
+        list = populate( N, 2, true );
+        add<scs>( list.begin(), list.end(), std::string( "unit" ) );
+    }, []( size_t N ) {
+        size_t bytes = 0;
+        for( auto &id : list ) bytes += dump( id ).size();
+        return sink = double( bytes ), N;
+    } } );
+    all.push_back( { "export", []( size_t N ) {
+        list = populate( N, 2, true );
+        add<scs>( list.begin(), list.end(), std::string( "unit" ) );
+    }, []( size_t N ) {
+        std::string out;
+        dump( out, JSON );
+        return sink = double( out.size() ), N;
+    } } );
+    return all;
+}
+
+result measure( const scenario &sc, size_t N ) {
+    const int runs = int( std::max<size_t>( 3, std::min<size_t>( 200, 1000000 / N ) ) );
+    result best { sc.name, N, 0, 0 };
+    for( int i = 0; i < runs; ++i ) {
+        world w;
+        world::scope use( w );
+        sc.setup( N );
+        size_t ops = 0;
+        double t = ms( [&]{ ops = sc.run( N ); } );
+        if( !i || t < best.ms ) best.ms = t, best.ops = ops;
+    }
+    return best;
+}
+
+// json (one result per line) or csv, as written by report()
+std::vector<result> load_results( const std::string &pathfile ) {
+    std::vector<result> list;
+    std::ifstream in( pathfile );
+    auto field = []( const std::string &line, const std::string &key ) {
+        size_t at = line.find( "\"" + key + "\":" );
+        if( at == std::string::npos ) return std::string();
+        at += key.size() + 3;
+        if( line[at] == '"' ) return line.substr( at + 1, line.find( '"', at + 1 ) - at - 1 );
+        return line.substr( at, line.find_first_of( ",}", at ) - at );
+    };
+    for( std::string line; std::getline( in, line ); ) {
+        result r;
+        if( line.find( "\"scenario\":" ) != std::string::npos ) {
+            r.scenario = field( line, "scenario" );
+            r.entities = std::stoull( field( line, "entities" ) ), r.ops = std::stoull( field( line, "ops" ) );
+            r.ms = std::stod( field( line, "ms" ) );
+        } else {
+            std::stringstream ss( line );
+            std::string entities, ops, time;
+            if( !std::getline( ss, r.scenario, ',' ) || !std::getline( ss, entities, ',' ) || !std::getline( ss, ops, ',' ) || !std::getline( ss, time, ',' ) ) continue;
+            if( r.scenario == "scenario" ) continue; // header
+            r.entities = std::stoull( entities ), r.ops = std::stoull( ops ), r.ms = std::stod( time );
+        }
+        list.push_back( r );
+    }
+    return list;
+}
+
+void report( std::ostream &out, const std::vector<result> &list, const std::string &format ) {
+    if( format == "json" ) {
+        out << "{\"kult\":\"" << std::string( KULT_VERSION ).substr( 0, 5 ) << "\",\"results\":[" << std::endl;
+        for( size_t i = 0; i < list.size(); ++i ) {
+            const result &r = list[i];
+            out << "{\"scenario\":\"" << r.scenario << "\",\"entities\":" << r.entities << ",\"ops\":" << r.ops
+                << ",\"ms\":" << r.ms << ",\"ns_per_op\":" << r.ns() << "}" << ( i + 1 < list.size() ? "," : "" ) << std::endl;
+        }
+        out << "]}" << std::endl;
+    }
+    if( format == "csv" ) {
+        out << "scenario,entities,ops,ms,ns_per_op" << std::endl;
+        for( auto &r : list ) out << r.scenario << ',' << r.entities << ',' << r.ops << ',' << r.ms << ',' << r.ns() << std::endl;
+    }
+}
+
+int compare();
 
 int main( int argc, char **argv )
+{
+    size_t max = 1000000;
+    double tolerance = 15;
+    std::string only, format, outfile, baseline;
+    for( int i = 1; i < argc; ++i ) {
+        const std::string arg = argv[i];
+        const bool more = i + 1 < argc;
+        /**/ if( arg == "compare" ) return compare();
+        else if( arg == "--max" && more ) max = std::stoull( argv[++i] );
+        else if( arg == "--only" && more ) only = argv[++i];
+        else if( arg == "--json" || arg == "--csv" ) format = arg.substr( 2 );
+        else if( arg == "--out" && more ) outfile = argv[++i];
+        else if( arg == "--baseline" && more ) baseline = argv[++i];
+        else if( arg == "--tolerance" && more ) tolerance = std::stod( argv[++i] );
+        else return std::cerr << "usage: " << argv[0] << " [--max N] [--only name] [--json|--csv] [--out file] [--baseline file] [--tolerance pct] | compare" << std::endl, 1;
+    }
+
+    std::vector<result> base;
+    if( !baseline.empty() ) base = load_results( baseline );
+    auto previous = [&]( const result &r ) -> const result * {
+        for( auto &b : base ) if( b.scenario == r.scenario && b.entities == r.entities ) return &b;
+        return 0;
+    };
+
+    std::ofstream file;
+    if( !outfile.empty() ) file.open( outfile );
+    std::ostream &machine = outfile.empty() ? std::cout : file;
+    std::ostream &human = format.empty() || !outfile.empty() ? std::cout : std::cerr;
+
+    std::vector<result> results;
+    size_t regressions = 0;
+    human << std::fixed << std::setprecision(2);
+    for( auto &sc : scenarios() ) {
+        if( !only.empty() && sc.name.find( only ) == std::string::npos ) continue;
+        for( size_t N = 1000; N <= max && N <= 10000000; N *= 10 ) {
+            results.push_back( measure( sc, N ) );
+            const result &r = results.back();
+            human << std::setw(10) << r.scenario << std::setw(10) << N << " entities: " << std::setw(10) << r.ms << " ms " << std::setw(8) << r.ns() << " ns/op";
+            if( const result *b = previous( r ) ) {
+                const double change = b->ns() ? ( r.ns() / b->ns() - 1 ) * 100 : 0;
+                human << "  " << std::showpos << change << std::noshowpos << "%";
+                if( change > tolerance ) human << " REGRESSION", ++regressions;
+            }
+            human << std::endl;
+        }
+    }
+    report( machine, results, format );
+    if( !base.empty() ) human << regressions << " regressions over " << tolerance << "% against " << baseline << std::endl;
+    return regressions ? 1 : 0;
+}
+
+// side-by-side comparisons of former implementations against the current ones
+int compare()
 {
     {
         // construct an object
@@ -89,5 +1046,160 @@ int main( int argc, char **argv )
         std::cout << dump(obj) << std::endl;
     }
 
+    {
+        // storage
+        using cache = component<'bnch', size_t>;
+
+        std::cout << "Benchmarking std::map -> kult::store... " << std::endl << std::fixed << std::setprecision(2);
+        bench_storage<cache>(   10000 );
+        bench_storage<cache>(  100000 );
+        bench_storage<cache>( 1000000 );
+    }
+
+    {
+        // footprint
+        using health   = component<'heal', int>;
+        using position = component<'pos2', vec2f>;
+        using name     = component<'name', std::string>;
+
+        std::cout << "Benchmarking memory footprint at 1M entities... " << std::endl;
+        bench_footprint<health>( "int", 1000000 );
+        bench_footprint<position>( "vec2f", 1000000 );
+        bench_footprint<name>( "std::string", 1000000 );
+    }
+
+    {
+        // joins
+        using j1 = component<'jn_1', int>;
+        using j2 = component<'jn_2', int>;
+        using j3 = component<'jn_3', int>;
+        using j4 = component<'jn_4', int>;
+
+        std::cout << "Benchmarking materialized joins -> join views... " << std::endl;
+        bench_join<j1,j2,j3,j4>(  10000, 100 );
+        bench_join<j1,j2,j3,j4>( 100000, 10 );
+
+        std::cout << "Benchmarking materialized join results, entity temporaries -> plain ids... " << std::endl;
+        bench_entity_sets<j1,j2>(  10000, 100 );
+        bench_entity_sets<j1,j2>( 100000, 10 );
+    }
+
+    {
+        // archetypes
+        std::cout << "Benchmarking movement system, join views -> archetype chunks... " << std::endl;
+        bench_archetypes(  100000, 10 );
+        bench_archetypes( 1000000, 10 );
+    }
+
+    {
+        // each
+        std::cout << "Benchmarking movement system, join views + get<>() -> each<>()... " << std::endl;
+        bench_each(  100000, 10 );
+        bench_each( 1000000, 10 );
+    }
+
+    {
+        // groups
+        std::cout << "Benchmarking movement system, join views -> persistent group... " << std::endl;
+        bench_groups(  100000, 10 );
+        bench_groups( 1000000, 10 );
+    }
+
+    {
+        // parallel
+        std::cout << "Benchmarking movement system, parallel_each over 1..N threads... " << std::endl;
+        bench_parallel( 1000000, 10 );
+    }
+
+    {
+        // commands
+        std::cout << "Benchmarking tag add/del, immediate -> command buffers... " << std::endl;
+        bench_commands(  100000 );
+        bench_commands( 1000000 );
+    }
+
+    {
+        // snapshots
+        std::cout << "Benchmarking checkpoints, dump() text -> binary snapshot... " << std::endl;
+        bench_snapshot(  100000 );
+        bench_snapshot( 1000000 );
+    }
+
+    {
+        // dumps
+        std::cout << "Benchmarking debug dumps, dump() strings -> streamed buffer -> world export... " << std::endl;
+        bench_dumps( 1000000 );
+    }
+
+    {
+        // deltas
+        std::cout << "Benchmarking replication, full snapshot -> diff/patch -> tracker... " << std::endl;
+        bench_delta( 100000, 10 );
+        bench_tracker( 100000, 10 );
+    }
+
+    {
+        // journal
+        std::cout << "Benchmarking editor undo, dump() per edit -> journal... " << std::endl;
+        bench_journal( 100000, 100000 );
+    }
+
+    {
+        // batches
+        std::cout << "Benchmarking unit waves, per-id -> batched... " << std::endl;
+        bench_batches(  50000 );
+        bench_batches( 500000 );
+    }
+
+    {
+        // signatures
+        std::cout << "Benchmarking whole-entity operations, all registered components -> signature bits... " << std::endl;
+        bench_signatures( 100000 );
+    }
+
+    {
+        // worlds
+        std::cout << "Benchmarking independent worlds, stepped one by one -> at once... " << std::endl;
+        bench_worlds( 100000, 4, 10 );
+    }
+
+    {
+        // sorting
+        std::cout << "Benchmarking joins after churn, as is -> sorted and aligned stores... " << std::endl;
+        bench_sort(  100000, 10 );
+        bench_sort( 1000000, 10 );
+    }
+
+    {
+        // versions
+        std::cout << "Benchmarking reactive systems, full scan -> changed<>() since last run... " << std::endl;
+        bench_versions( 1000000, 1000, 10 );
+        bench_versions( 1000000, 100000, 10 );
+    }
+
+    {
+        // observers
+        std::cout << "Benchmarking render list upkeep (both incl. the churn itself), diffing join() -> batched observers... " << std::endl;
+        bench_observers( 1000000, 1000, 10 );
+    }
+
+    {
+        // registry
+        std::cout << "Benchmarking whole-entity operations, runtime registry -> registry<T...>... " << std::endl;
+        bench_registry( 1000000 );
+    }
+
+    {
+        // memory
+        std::cout << "Benchmarking spawn/purge churn, heap -> arena... " << std::endl;
+        bench_arena( 100000, 20 );
+    }
+
+    {
+        // split payloads
+        std::cout << "Benchmarking movement over groups, aos -> soa columns... " << std::endl;
+        bench_split( 1000000, 100 );
+    }
+
     return 0;
 }
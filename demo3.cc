@@ -14,10 +14,10 @@ using position = component<'pos2', vec2>;
 using velocity = component<'vel2', vec2>;
 
 void movementSystem( float delta ) {
-    for( auto &id : join<position,velocity>() ) {
-        get<position>(id).x += get<velocity>(id).x * delta;
-        get<position>(id).y += get<velocity>(id).y * delta;
-    }
+    each<position,velocity>( [&]( type id, vec2 &p, vec2 &v ) {
+        p.x += v.x * delta;
+        p.y += v.y * delta;
+    } );
 };
 
 int main(int argc, char **argv) {